@@ -0,0 +1,247 @@
+// analytics.cpp
+#include "analytics.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char snapshotMagic[8] = { 'D', 'I', 'C', 'E', 'F', 'A', 'I', 'R' };
+static const uint32_t snapshotVersion = 1;
+
+int facesOf(DieType type) {
+    switch (type) {
+        case DieType::D4:  return 4;
+        case DieType::D6:  return 6;
+        case DieType::D8:  return 8;
+        case DieType::D10: return 10;
+        case DieType::D12: return 12;
+        case DieType::D20: return 20;
+    }
+    return 0;
+}
+
+RollAnalytics::RollAnalytics() {
+    for (DieStats& die : stats) {
+        for (std::atomic<uint64_t>& count : die.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        die.lagProducts.store(0, std::memory_order_relaxed);
+    }
+}
+
+void RollAnalytics::recordRoll(RollStream& stream, DieType type, int face) {
+    recordBatch(stream, type, &face, 1);
+}
+
+void RollAnalytics::recordBatch(RollStream& stream, DieType type, const int* faces, size_t count) {
+    int faceCount = facesOf(type);
+    int& lastFace = stream.lastFace[static_cast<int>(type)];
+
+    // Tally locally first so the shared counters see one update per face instead of one per roll
+    uint64_t counts[maxDieFaces] = {};
+    uint64_t lagProducts = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int face = faces[i];
+        if (face < 1 || face > faceCount) {
+            continue;
+        }
+        ++counts[face - 1];
+        lagProducts += static_cast<uint64_t>(lastFace) * face; // lastFace is 0 before the first roll
+        lastFace = face;
+    }
+    publish(type, counts, lagProducts);
+}
+
+void RollAnalytics::publish(DieType type, const uint64_t* counts, uint64_t lagProducts) {
+    DieStats& die = stats[static_cast<int>(type)];
+    int faceCount = facesOf(type);
+
+    for (int i = 0; i < faceCount; ++i) {
+        if (counts[i] != 0) {
+            die.counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+        }
+    }
+    if (lagProducts != 0) {
+        die.lagProducts.fetch_add(lagProducts, std::memory_order_relaxed);
+    }
+}
+
+FairnessReport RollAnalytics::report(DieType type) const {
+    const DieStats& die = stats[static_cast<int>(type)];
+    int faceCount = facesOf(type);
+
+    FairnessReport result;
+    result.degreesOfFreedom = faceCount - 1;
+    result.maxEntropy = std::log2(static_cast<double>(faceCount));
+
+    // Every sum comes from the same load of the counters, so they always describe the same rolls.
+    // Only the lag product sum is read separately and can be a batch ahead or behind while others record.
+    double counts[maxDieFaces];
+    double total = 0.0, sumFaces = 0.0, sumFaceSquares = 0.0, countLogCount = 0.0;
+    uint64_t n = 0;
+    for (int i = 0; i < faceCount; ++i) {
+        uint64_t count = die.counts[i].load(std::memory_order_relaxed);
+        double face = static_cast<double>(i + 1);
+        counts[i] = static_cast<double>(count);
+        n += count;
+        sumFaces += face * counts[i];
+        sumFaceSquares += face * face * counts[i];
+        if (count > 0) {
+            countLogCount += counts[i] * std::log(counts[i]);
+        }
+    }
+    result.rolls = n;
+    if (n == 0) {
+        return result;
+    }
+    total = static_cast<double>(n);
+
+    // sum((O - E)^2 / E) with E = n / k
+    double expected = total / faceCount;
+    for (int i = 0; i < faceCount; ++i) {
+        double difference = counts[i] - expected;
+        result.chiSquare += difference * difference / expected;
+    }
+
+    // H = ln(n) - sum(O * ln(O)) / n, converted to bits
+    result.entropy = (std::log(total) - countLogCount / total) / std::log(2.0);
+
+    // Knuth's serial correlation coefficient: (n * sum(x[i] * x[i - 1]) - sum(x)^2) / (n * sum(x^2) - sum(x)^2)
+    double lagProducts = static_cast<double>(die.lagProducts.load(std::memory_order_relaxed));
+    double denominator = total * sumFaceSquares - sumFaces * sumFaces;
+    if (denominator > 0.0) {
+        result.serialCorrelation = (total * lagProducts - sumFaces * sumFaces) / denominator;
+    }
+    return result;
+}
+
+// Snapshot layout (native byte order, no padding): 8 byte magic "DICEFAIR", uint32 version,
+// uint32 die type count, then for every die type in DieType order: uint64 face count, one uint64
+// count per face and the uint64 lag product sum. Everything else is derived from these.
+// The file is written next to the target and then renamed over it, so a crash never leaves half a snapshot.
+bool RollAnalytics::saveSnapshot(const std::string& path) const {
+    std::string tempPath = path + ".tmp";
+    std::vector<uint64_t> body;
+    for (int t = 0; t < dieTypeCount; ++t) {
+        const DieStats& die = stats[t];
+        int faceCount = facesOf(static_cast<DieType>(t));
+        body.push_back(static_cast<uint64_t>(faceCount));
+        for (int i = 0; i < faceCount; ++i) {
+            body.push_back(die.counts[i].load(std::memory_order_relaxed));
+        }
+        body.push_back(die.lagProducts.load(std::memory_order_relaxed));
+    }
+
+    uint32_t header[2] = { snapshotVersion, static_cast<uint32_t>(dieTypeCount) };
+    size_t size = sizeof(snapshotMagic) + sizeof(header) + body.size() * sizeof(uint64_t);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to create snapshot file: " << path << std::endl;
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(size), NULL);
+    char* data = mapping ? static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size)) : nullptr;
+    if (!data) {
+        std::cerr << "Failed to map snapshot file: " << path << std::endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+#else
+    int file = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        std::cerr << "Failed to create snapshot file: " << path << std::endl;
+        return false;
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(file, static_cast<off_t>(size)) == 0) {
+        mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map snapshot file: " << path << std::endl;
+        close(file);
+        return false;
+    }
+    char* data = static_cast<char*>(mapped);
+#endif
+
+    std::memcpy(data, snapshotMagic, sizeof(snapshotMagic));
+    std::memcpy(data + sizeof(snapshotMagic), header, sizeof(header));
+    std::memcpy(data + sizeof(snapshotMagic) + sizeof(header), body.data(), body.size() * sizeof(uint64_t));
+
+#ifdef _WIN32
+    bool flushed = FlushViewOfFile(data, size) != 0;
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    bool flushed = msync(data, size, MS_SYNC) == 0;
+    munmap(data, size);
+    close(file);
+#endif
+    if (!flushed) {
+        std::cerr << "Failed to write snapshot file: " << tempPath << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    bool replaced = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool replaced = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced) {
+        std::cerr << "Failed to replace snapshot file: " << path << std::endl;
+    }
+    return replaced;
+}
+
+bool RollAnalytics::loadSnapshot(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        if (errno != ENOENT) {
+            std::cerr << "Failed to open snapshot file: " << path << std::endl;
+        }
+        return false;
+    }
+
+    char magic[sizeof(snapshotMagic)];
+    uint32_t header[2] = {};
+    bool ok = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+        && std::memcmp(magic, snapshotMagic, sizeof(magic)) == 0
+        && std::fread(header, sizeof(uint32_t), 2, file) == 2
+        && header[0] == snapshotVersion && header[1] == static_cast<uint32_t>(dieTypeCount);
+
+    // Read everything first so a truncated or foreign file leaves the counters untouched
+    uint64_t counts[dieTypeCount][maxDieFaces] = {};
+    uint64_t lagProducts[dieTypeCount] = {};
+    for (int t = 0; ok && t < dieTypeCount; ++t) {
+        int faceCount = facesOf(static_cast<DieType>(t));
+        uint64_t storedFaces = 0;
+        ok = std::fread(&storedFaces, sizeof(uint64_t), 1, file) == 1 && storedFaces == static_cast<uint64_t>(faceCount)
+            && std::fread(counts[t], sizeof(uint64_t), faceCount, file) == static_cast<size_t>(faceCount)
+            && std::fread(&lagProducts[t], sizeof(uint64_t), 1, file) == 1;
+    }
+    std::fclose(file);
+
+    if (!ok) {
+        std::cerr << "Not a valid roll snapshot: " << path << std::endl;
+        return false;
+    }
+
+    for (int t = 0; t < dieTypeCount; ++t) {
+        publish(static_cast<DieType>(t), counts[t], lagProducts[t]);
+    }
+    return true;
+}
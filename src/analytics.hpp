@@ -0,0 +1,66 @@
+// analytics.hpp
+#ifndef ANALYTICS_HPP
+#define ANALYTICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class DieType { D4, D6, D8, D10, D12, D20 };
+
+const int dieTypeCount = 6;
+const int maxDieFaces = 20;
+
+int facesOf(DieType type);
+
+struct FairnessReport {
+    uint64_t rolls = 0;
+    double chiSquare = 0.0;         // Against a uniform distribution
+    int degreesOfFreedom = 0;
+    double entropy = 0.0;           // Bits per roll
+    double maxEntropy = 0.0;        // log2(faces), what a fair die gives
+    double serialCorrelation = 0.0; // Lag 1, close to 0 for independent rolls
+};
+
+// Per producer state (one per thread, interactive session or batch), carries the previous face
+// of every die type so consecutive rolls can be paired for the serial correlation
+struct RollStream {
+    int lastFace[dieTypeCount] = {};
+};
+
+// Face histograms for every die type.
+// Recording is lock free and safe from any number of threads and costs O(1) per roll (one atomic add
+// per face per batch). Every statistic is derived from the face counts and the lag product sum, so a
+// report is O(faces) and never rescans the roll history.
+class RollAnalytics {
+public:
+    RollAnalytics();
+
+    // face is 1 based, out of range faces are ignored
+    void recordRoll(RollStream& stream, DieType type, int face);
+
+    // Record many rolls at once, only touches the shared counters once per face, use this for headless runs
+    void recordBatch(RollStream& stream, DieType type, const int* faces, size_t count);
+
+    FairnessReport report(DieType type) const;
+
+    // Write the histograms to a compact binary file through a memory mapping
+    bool saveSnapshot(const std::string& path) const;
+
+    // Add the counts from a snapshot written by saveSnapshot (e.g. earlier sessions), false if missing or invalid
+    bool loadSnapshot(const std::string& path);
+
+private:
+    // Own cache line per die type so producers rolling different dice do not share lines
+    struct alignas(64) DieStats {
+        std::atomic<uint64_t> counts[maxDieFaces];
+        std::atomic<uint64_t> lagProducts; // Sum of face[i] * face[i - 1]
+    };
+
+    void publish(DieType type, const uint64_t* counts, uint64_t lagProducts);
+
+    DieStats stats[dieTypeCount];
+};
+
+#endif // ANALYTICS_HPP
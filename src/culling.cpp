@@ -0,0 +1,247 @@
+// culling.cpp
+#include "culling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "simd.hpp"
+
+static const uint8_t culledLod = 0xFF;
+// Below this many blocks per thread, waking workers costs more than it saves
+static const size_t minBlocksPerThread = 512;
+
+FrustumPlanes extractFrustumPlanes(const glm::mat4& viewProjection) {
+    const glm::mat4& m = viewProjection;
+    FrustumPlanes frustum;
+    // Rows of the matrix (glm is column major), planes are row3 +/- row0..2
+    for (int i = 0; i < 6; ++i) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float a = m[0][3] + sign * m[0][row];
+        float b = m[1][3] + sign * m[1][row];
+        float c = m[2][3] + sign * m[2][row];
+        float d = m[3][3] + sign * m[3][row];
+        float invLength = 1.0f / std::sqrt(a * a + b * b + c * c);
+        frustum.a[i] = a * invLength;
+        frustum.b[i] = b * invLength;
+        frustum.c[i] = c * invLength;
+        frustum.d[i] = d * invLength;
+    }
+    return frustum;
+}
+
+void DiceSpheres::resize(size_t diceCount) {
+    count = diceCount;
+    size_t padded = (diceCount + cullBlockSize - 1) / cullBlockSize * cullBlockSize;
+    x.resize(padded, 0.0f);
+    y.resize(padded, 0.0f);
+    z.resize(padded, 0.0f);
+    radius.resize(padded, 0.0f);
+}
+
+void DiceSpheres::set(size_t index, const glm::vec3& centre, float sphereRadius) {
+    x[index] = centre.x;
+    y[index] = centre.y;
+    z[index] = centre.z;
+    radius[index] = sphereRadius;
+}
+
+size_t CullResult::visibleCount() const {
+    size_t total = 0;
+    for (int lod = 0; lod < diceLodCount; ++lod) {
+        total += visible[lod].size();
+    }
+    return total;
+}
+
+float projectionPixelScale(const glm::mat4& projection, int windowHeight) {
+    return projection[1][1] * windowHeight * 0.5f;
+}
+
+// Test one block of cullBlockSize dice and write their LOD (or culledLod) to lods
+static void cullBlock(const DiceSpheres& spheres, const FrustumPlanes& frustum, const glm::vec3& cameraPos, float pixelScale, const LodSettings& settings, size_t base, uint8_t* lods) {
+#if defined(DICE_SIMD_AVX)
+    __m256 px = _mm256_loadu_ps(&spheres.x[base]);
+    __m256 py = _mm256_loadu_ps(&spheres.y[base]);
+    __m256 pz = _mm256_loadu_ps(&spheres.z[base]);
+    __m256 r = _mm256_loadu_ps(&spheres.radius[base]);
+    __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int i = 0; i < 6; ++i) {
+        __m256 distance = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.a[i]), px), _mm256_mul_ps(_mm256_set1_ps(frustum.b[i]), py)),
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.c[i]), pz), _mm256_set1_ps(frustum.d[i])));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negR, _CMP_GE_OQ));
+    }
+
+    // Projected radius in pixels, a camera inside the sphere counts as distance = radius
+    __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(cameraPos.x));
+    __m256 dy = _mm256_sub_ps(py, _mm256_set1_ps(cameraPos.y));
+    __m256 dz = _mm256_sub_ps(pz, _mm256_set1_ps(cameraPos.z));
+    __m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+    __m256 distance = _mm256_sqrt_ps(_mm256_max_ps(distanceSq, _mm256_mul_ps(r, r)));
+    __m256 screenRadius = _mm256_div_ps(_mm256_mul_ps(r, _mm256_set1_ps(pixelScale)), distance);
+    inside = _mm256_and_ps(inside, _mm256_cmp_ps(screenRadius, _mm256_set1_ps(settings.minRadius), _CMP_GE_OQ));
+
+    __m256 lod = _mm256_setzero_ps();
+    for (int i = 0; i < diceLodCount - 1; ++i) {
+        __m256 smaller = _mm256_cmp_ps(screenRadius, _mm256_set1_ps(settings.lodRadius[i]), _CMP_LT_OQ);
+        lod = _mm256_add_ps(lod, _mm256_and_ps(smaller, _mm256_set1_ps(1.0f)));
+    }
+
+    alignas(32) int lodLanes[cullBlockSize];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lodLanes), _mm256_cvttps_epi32(lod));
+    int mask = _mm256_movemask_ps(inside);
+    for (int lane = 0; lane < cullBlockSize; ++lane) {
+        lods[lane] = (mask & (1 << lane)) ? static_cast<uint8_t>(lodLanes[lane]) : culledLod;
+    }
+#elif defined(DICE_SIMD_SSE)
+    // Two 4 wide halves of the block
+    for (int half = 0; half < cullBlockSize; half += 4) {
+        __m128 px = _mm_loadu_ps(&spheres.x[base + half]);
+        __m128 py = _mm_loadu_ps(&spheres.y[base + half]);
+        __m128 pz = _mm_loadu_ps(&spheres.z[base + half]);
+        __m128 r = _mm_loadu_ps(&spheres.radius[base + half]);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int i = 0; i < 6; ++i) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.a[i]), px), _mm_mul_ps(_mm_set1_ps(frustum.b[i]), py)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.c[i]), pz), _mm_set1_ps(frustum.d[i])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negR));
+        }
+
+        __m128 dx = _mm_sub_ps(px, _mm_set1_ps(cameraPos.x));
+        __m128 dy = _mm_sub_ps(py, _mm_set1_ps(cameraPos.y));
+        __m128 dz = _mm_sub_ps(pz, _mm_set1_ps(cameraPos.z));
+        __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 distance = _mm_sqrt_ps(_mm_max_ps(distanceSq, _mm_mul_ps(r, r)));
+        __m128 screenRadius = _mm_div_ps(_mm_mul_ps(r, _mm_set1_ps(pixelScale)), distance);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(screenRadius, _mm_set1_ps(settings.minRadius)));
+
+        __m128 lod = _mm_setzero_ps();
+        for (int i = 0; i < diceLodCount - 1; ++i) {
+            __m128 smaller = _mm_cmplt_ps(screenRadius, _mm_set1_ps(settings.lodRadius[i]));
+            lod = _mm_add_ps(lod, _mm_and_ps(smaller, _mm_set1_ps(1.0f)));
+        }
+
+        alignas(16) int lodLanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lodLanes), _mm_cvttps_epi32(lod));
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            lods[half + lane] = (mask & (1 << lane)) ? static_cast<uint8_t>(lodLanes[lane]) : culledLod;
+        }
+    }
+#else
+    // Same maths one lane at a time, branch free so the compiler can vectorise the lane loops
+    const float* px = &spheres.x[base];
+    const float* py = &spheres.y[base];
+    const float* pz = &spheres.z[base];
+    const float* r = &spheres.radius[base];
+
+    int inside[cullBlockSize];
+    for (int lane = 0; lane < cullBlockSize; ++lane) {
+        inside[lane] = 1;
+    }
+    for (int i = 0; i < 6; ++i) {
+        for (int lane = 0; lane < cullBlockSize; ++lane) {
+            float distance = frustum.a[i] * px[lane] + frustum.b[i] * py[lane] + frustum.c[i] * pz[lane] + frustum.d[i];
+            inside[lane] &= (distance >= -r[lane]);
+        }
+    }
+
+    int lod[cullBlockSize];
+    for (int lane = 0; lane < cullBlockSize; ++lane) {
+        float dx = px[lane] - cameraPos.x;
+        float dy = py[lane] - cameraPos.y;
+        float dz = pz[lane] - cameraPos.z;
+        float distance = std::sqrt(std::max(dx * dx + dy * dy + dz * dz, r[lane] * r[lane]));
+        float screenRadius = r[lane] * pixelScale / distance;
+
+        lod[lane] = 0;
+        for (int i = 0; i < diceLodCount - 1; ++i) {
+            lod[lane] += (screenRadius < settings.lodRadius[i]);
+        }
+        inside[lane] &= (screenRadius >= settings.minRadius);
+    }
+    for (int lane = 0; lane < cullBlockSize; ++lane) {
+        lods[lane] = static_cast<uint8_t>(inside[lane] ? lod[lane] : culledLod);
+    }
+#endif
+}
+
+// Run work(chunk) for every chunk, on the persistent workers when there is more than one
+static void runChunks(CullResult& result, size_t threadCount, const std::function<void(size_t)>& work) {
+    if (threadCount == 1) {
+        work(0);
+        return;
+    }
+    result.workers->run(threadCount, work);
+}
+
+void cullDice(const DiceSpheres& spheres, const FrustumPlanes& frustum, const glm::vec3& cameraPos, float pixelScale, const LodSettings& settings, CullResult& result) {
+    size_t blockCount = (spheres.count + cullBlockSize - 1) / cullBlockSize;
+    result.lodOfDie.resize(blockCount * cullBlockSize);
+
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), blockCount / minBlocksPerThread));
+    if (threadCount > 1 && (!result.workers || result.workers->size() < threadCount)) {
+        // Started once and kept with the result, so later frames only have to wake them
+        result.workers.reset(new WorkerPool(threadCount - 1));
+    }
+    size_t blocksPerThread = (blockCount + threadCount - 1) / std::max<size_t>(threadCount, 1);
+
+    // Each chunk is a contiguous range of dice, counts[chunk][lod] = visible dice of that LOD in the chunk
+    std::vector<size_t> counts(threadCount * diceLodCount, 0);
+    auto chunkRange = [&](size_t chunk, size_t& begin, size_t& end) {
+        begin = std::min(chunk * blocksPerThread * cullBlockSize, spheres.count);
+        end = std::min((chunk + 1) * blocksPerThread * cullBlockSize, spheres.count);
+    };
+
+    auto testChunk = [&](size_t chunk) {
+        size_t firstBlock = chunk * blocksPerThread;
+        size_t lastBlock = std::min(firstBlock + blocksPerThread, blockCount);
+        for (size_t block = firstBlock; block < lastBlock; ++block) {
+            cullBlock(spheres, frustum, cameraPos, pixelScale, settings, block * cullBlockSize, &result.lodOfDie[block * cullBlockSize]);
+        }
+        size_t begin, end;
+        chunkRange(chunk, begin, end);
+        size_t* chunkCounts = &counts[chunk * diceLodCount];
+        for (size_t i = begin; i < end; ++i) {
+            uint8_t lod = result.lodOfDie[i];
+            if (lod != culledLod) {
+                ++chunkCounts[lod];
+            }
+        }
+    };
+
+    // Turn the per chunk counts into write offsets so every chunk can write its survivors without locking
+    std::vector<size_t> offsets(threadCount * diceLodCount, 0);
+    auto compactChunk = [&](size_t chunk) {
+        size_t begin, end;
+        chunkRange(chunk, begin, end);
+        size_t cursor[diceLodCount];
+        for (int lod = 0; lod < diceLodCount; ++lod) {
+            cursor[lod] = offsets[chunk * diceLodCount + lod];
+        }
+        for (size_t i = begin; i < end; ++i) {
+            uint8_t lod = result.lodOfDie[i];
+            if (lod != culledLod) {
+                result.visible[lod][cursor[lod]++] = static_cast<unsigned int>(i);
+            }
+        }
+    };
+
+    runChunks(result, threadCount, testChunk);
+
+    for (int lod = 0; lod < diceLodCount; ++lod) {
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < threadCount; ++chunk) {
+            offsets[chunk * diceLodCount + lod] = total;
+            total += counts[chunk * diceLodCount + lod];
+        }
+        result.visible[lod].resize(total);
+    }
+
+    runChunks(result, threadCount, compactChunk);
+}
@@ -0,0 +1,57 @@
+// culling.hpp
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "workerPool.hpp"
+
+// Dice are tested in blocks of this many at a time
+const int cullBlockSize = 8;
+const int diceLodCount = 3;
+
+// The six planes of the view frustum, normalised, stored as separate arrays so they can be broadcast
+struct FrustumPlanes {
+    float a[6], b[6], c[6], d[6];
+};
+
+// Build the frustum planes from projection * view (left, right, bottom, top, near, far)
+FrustumPlanes extractFrustumPlanes(const glm::mat4& viewProjection);
+
+// Bounding spheres of all dice, one array per component, padded to a multiple of cullBlockSize
+struct DiceSpheres {
+    std::vector<float> x, y, z, radius;
+    size_t count = 0;
+
+    void resize(size_t diceCount);
+    void set(size_t index, const glm::vec3& centre, float sphereRadius);
+};
+
+struct LodSettings {
+    // A die whose projected radius (pixels) is at least lodRadius[i] uses LOD i, smaller ones use the last LOD
+    float lodRadius[diceLodCount - 1] = { 48.0f, 12.0f };
+    // Dice smaller than this on screen are not drawn at all
+    float minRadius = 0.5f;
+};
+
+struct CullResult {
+    // Indices of the visible dice for each LOD, ready to be uploaded as instance data
+    std::vector<unsigned int> visible[diceLodCount];
+    // Scratch space reused between frames
+    std::vector<uint8_t> lodOfDie;
+    // Worker threads, created by the first large cull
+    std::unique_ptr<WorkerPool> workers;
+
+    size_t visibleCount() const;
+};
+
+// Scale that turns a world-space radius at distance 1 into pixels: projection[1][1] * windowHeight / 2
+float projectionPixelScale(const glm::mat4& projection, int windowHeight);
+
+// Frustum cull all dice, pick a LOD for the survivors and compact them into result.
+// Large scenes are split across threads.
+void cullDice(const DiceSpheres& spheres, const FrustumPlanes& frustum, const glm::vec3& cameraPos, float pixelScale, const LodSettings& settings, CullResult& result);
+
+#endif // CULLING_HPP
@@ -0,0 +1,217 @@
+// damage.cpp
+#include "damage.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(DICE_EGL_DAMAGE) // Linux with SFML built for EGL contexts
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(DICE_GLX_BUFFER_AGE) // Linux with SFML's default GLX contexts
+#include <GL/glx.h>
+#ifndef GLX_BACK_BUFFER_AGE_EXT
+#define GLX_BACK_BUFFER_AGE_EXT 0x20F4
+#endif
+#endif
+
+// Extra pixels around every rect to cover MSAA resolve and rounding
+static const int damagePadding = 2;
+
+ScreenRect unionRects(const ScreenRect& a, const ScreenRect& b) {
+    if (a.isEmpty()) return b;
+    if (b.isEmpty()) return a;
+
+    int left = std::min(a.x, b.x);
+    int bottom = std::min(a.y, b.y);
+    int right = std::max(a.x + a.width, b.x + b.width);
+    int top = std::max(a.y + a.height, b.y + b.height);
+    return ScreenRect{ left, bottom, right - left, top - bottom };
+}
+
+ScreenRect clampRect(const ScreenRect& rect, int windowWidth, int windowHeight) {
+    int left = std::max(rect.x, 0);
+    int bottom = std::max(rect.y, 0);
+    int right = std::min(rect.x + rect.width, windowWidth);
+    int top = std::min(rect.y + rect.height, windowHeight);
+    if (right <= left || top <= bottom) {
+        return ScreenRect{};
+    }
+    return ScreenRect{ left, bottom, right - left, top - bottom };
+}
+
+ScreenRect projectBoundsToScreen(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const glm::mat4& mvp, int windowWidth, int windowHeight) {
+    ScreenRect fullWindow{ 0, 0, windowWidth, windowHeight };
+    float minX = INFINITY, minY = INFINITY;
+    float maxX = -INFINITY, maxY = -INFINITY;
+
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 corner(
+            (i & 1) ? aabbMax.x : aabbMin.x,
+            (i & 2) ? aabbMax.y : aabbMin.y,
+            (i & 4) ? aabbMax.z : aabbMin.z,
+            1.0f);
+        glm::vec4 clip = mvp * corner;
+        if (clip.w <= 0.0f) {
+            return fullWindow; // Corner behind the camera, projected bounds are meaningless
+        }
+
+        // NDC to window coordinates, same mapping as the default viewport
+        float x = (clip.x / clip.w * 0.5f + 0.5f) * windowWidth;
+        float y = (clip.y / clip.w * 0.5f + 0.5f) * windowHeight;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    ScreenRect rect;
+    rect.x = static_cast<int>(std::floor(minX)) - damagePadding;
+    rect.y = static_cast<int>(std::floor(minY)) - damagePadding;
+    rect.width = static_cast<int>(std::ceil(maxX)) + damagePadding - rect.x;
+    rect.height = static_cast<int>(std::ceil(maxY)) + damagePadding - rect.y;
+    return clampRect(rect, windowWidth, windowHeight);
+}
+
+void DamageTracker::beginFrame(int windowWidth, int windowHeight) {
+    if (windowWidth != width || windowHeight != height) {
+        width = windowWidth;
+        height = windowHeight;
+        history.clear();
+        forceFullRepaint = true;
+    }
+    current = ScreenRect{};
+}
+
+void DamageTracker::addRect(const ScreenRect& rect) {
+    current = unionRects(current, clampRect(rect, width, height));
+}
+
+ScreenRect DamageTracker::repaintRegion(int bufferAge) const {
+    ScreenRect fullWindow{ 0, 0, width, height };
+    // The back buffer holds the frame from bufferAge frames ago, everything drawn since then has to go
+    if (forceFullRepaint || bufferAge <= 0 || static_cast<size_t>(bufferAge) > history.size()) {
+        return fullWindow;
+    }
+
+    ScreenRect region = current;
+    for (int i = 0; i < bufferAge; ++i) {
+        region = unionRects(region, history[i]);
+    }
+    return region;
+}
+
+ScreenRect DamageTracker::swapDamage() const {
+    if (forceFullRepaint || history.empty()) {
+        return ScreenRect{ 0, 0, width, height };
+    }
+    return unionRects(current, history.front());
+}
+
+void DamageTracker::endFrame() {
+    history.push_front(current);
+    if (history.size() > maxHistory) {
+        history.pop_back();
+    }
+    forceFullRepaint = false;
+}
+
+#if defined(DICE_EGL_DAMAGE) || defined(DICE_GLX_BUFFER_AGE)
+
+// Whole word match in a space separated extension string
+static bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+
+    size_t length = std::strlen(name);
+    for (const char* found = std::strstr(extensions, name); found; found = std::strstr(found + length, name)) {
+        bool startsWord = (found == extensions) || (found[-1] == ' ');
+        bool endsWord = (found[length] == ' ') || (found[length] == '\0');
+        if (startsWord && endsWord) return true;
+    }
+    return false;
+}
+
+#endif
+
+#if defined(DICE_EGL_DAMAGE)
+
+int queryBufferAge() {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLSurface surface = eglGetCurrentSurface(EGL_DRAW);
+    if (display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE) {
+        return 0; // No current EGL context
+    }
+
+    static const bool hasBufferAge = hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_EXT_buffer_age");
+    if (!hasBufferAge) return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, &age)) {
+        return 0;
+    }
+    return age;
+}
+
+void presentWithDamage(sf::Window& window, const ScreenRect& damage) {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLSurface surface = eglGetCurrentSurface(EGL_DRAW);
+    if (display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE || damage.isEmpty()) {
+        window.display();
+        return;
+    }
+
+    // KHR and EXT versions share the same signature
+    static PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swapWithDamage = [display]() -> PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC {
+        if (hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_swap_buffers_with_damage")) {
+            return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+        }
+        if (hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_EXT_swap_buffers_with_damage")) {
+            return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+        }
+        return nullptr;
+    }();
+
+    if (!swapWithDamage) {
+        window.display();
+        return;
+    }
+
+    EGLint rect[4] = { damage.x, damage.y, damage.width, damage.height };
+    if (!swapWithDamage(display, surface, rect, 1)) {
+        window.display();
+    }
+}
+
+#elif defined(DICE_GLX_BUFFER_AGE)
+
+int queryBufferAge() {
+    Display* display = glXGetCurrentDisplay();
+    GLXDrawable drawable = glXGetCurrentDrawable();
+    if (!display || !drawable) {
+        return 0;
+    }
+
+    static const bool hasBufferAge = hasExtension(glXQueryExtensionsString(display, DefaultScreen(display)), "GLX_EXT_buffer_age");
+    if (!hasBufferAge) return 0;
+
+    unsigned int age = 0;
+    glXQueryDrawable(display, drawable, GLX_BACK_BUFFER_AGE_EXT, &age);
+    return static_cast<int>(age);
+}
+
+void presentWithDamage(sf::Window& window, const ScreenRect& damage) {
+    (void)damage; // GLX has no swap with damage, the compositor is told the whole window changed
+    window.display();
+}
+
+#else
+
+int queryBufferAge() {
+    return 0; // No way to know what is left in the back buffer, repaint everything
+}
+
+void presentWithDamage(sf::Window& window, const ScreenRect& damage) {
+    (void)damage;
+    window.display();
+}
+
+#endif
@@ -0,0 +1,63 @@
+// damage.hpp
+#ifndef DAMAGE_HPP
+#define DAMAGE_HPP
+
+#include <deque>
+#include <SFML/Window.hpp>
+#include <glm/glm.hpp>
+
+// Rectangle in OpenGL window coordinates (origin bottom-left, like glScissor and EGL damage rects)
+struct ScreenRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool isEmpty() const { return width <= 0 || height <= 0; }
+};
+
+ScreenRect unionRects(const ScreenRect& a, const ScreenRect& b);
+ScreenRect clampRect(const ScreenRect& rect, int windowWidth, int windowHeight);
+
+// Project a model-space AABB through projection * view * model and return its screen bounds.
+// Returns the whole window if any corner is behind the camera (the bounds cannot be trusted then).
+ScreenRect projectBoundsToScreen(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const glm::mat4& mvp, int windowWidth, int windowHeight);
+
+// Keeps the screen bounds of everything drawn in the last few frames so only the changed part
+// of the back buffer has to be cleared and redrawn.
+class DamageTracker {
+public:
+    // Start a new frame, throws away the history if the window size changed
+    void beginFrame(int windowWidth, int windowHeight);
+
+    // Add the screen bounds of a die or UI element drawn this frame
+    void addRect(const ScreenRect& rect);
+
+    // Area that has to be repainted given the age of the back buffer (0 = unknown contents)
+    ScreenRect repaintRegion(int bufferAge) const;
+
+    // Area that changed on screen since the last presented frame (passed to the compositor)
+    ScreenRect swapDamage() const;
+
+    // Store this frame's bounds in the history
+    void endFrame();
+
+private:
+    static const size_t maxHistory = 3;
+
+    int width = 0;
+    int height = 0;
+    bool forceFullRepaint = true;
+    ScreenRect current;
+    std::deque<ScreenRect> history; // front = previous frame
+};
+
+// Age of the back buffer (EGL_EXT_buffer_age or GLX_EXT_buffer_age), 0 if unknown.
+// Always 0 on Windows, so WGL windows are repainted in full every frame.
+int queryBufferAge();
+
+// Present the frame, telling the compositor which part changed when
+// EGL_KHR_swap_buffers_with_damage is available (EGL contexts only), otherwise falls back to window.display()
+void presentWithDamage(sf::Window& window, const ScreenRect& damage);
+
+#endif // DAMAGE_HPP
@@ -1,67 +1,39 @@
 //dice.cpp
 #include "dice.hpp"
+#include "diceGeometry.hpp"
 #include <vector>
 #include <iostream>
 
 
-float d6vertices[] = {
-    // positions          // colors             // Face: Left (Yellow)
-    -0.5f, -0.5f,  0.5f,  1.0f, 1.0f, 0.0f, // 12 (was 4)
-    -0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 0.0f, // 13 (was 0)
-    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f, // 14 (was 3)
-    -0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f, // 15 (was 7)
-
-    // positions          // colors             // Face: Top (Magenta)
-    -0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 1.0f, // 16 (was 3)
-    0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 1.0f, // 17 (was 2)
-    0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f, // 18 (was 6)
-    -0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 1.0f, // 19 (was 7)
-
-    // positions          // colors             // Face: Bottom (Cyan)
-    -0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 1.0f, // 20 (was 4)
-    0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 1.0f, // 21 (was 5)
-    0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f, // 22 (was 1)
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  // 23 (was 0)
-
-    // positions          // colors             // Face: Front (Red)
-    -0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 0
-    0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 1
-    0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 2
-    -0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 3
-
-    // positions          // colors             // Face: Right (Green)
-    0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, // 4 (was 1)
-    0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 0.0f, // 5
-    0.5f,  0.5f,  0.5f,  0.0f, 1.0f, 0.0f, // 6
-    0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f, // 7 (was 2)
-
-    // positions          // colors             // Face: Back (Blue)
-    0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 8 (was 5)
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 9 (was 4)
-    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 10 (was 7)
-    0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 11 (was 6)
-};
-
-unsigned int d6indices[] = {
-    0,  1,  2,  2,  3,  0,   // Front
-    4,  5,  6,  6,  7,  4,   // Back
-    8,  9,  10, 10, 11, 8,   // Top
-    12, 13, 14, 14, 15, 12,  // Bottom
-    16, 17, 18, 18, 19, 16,  // Right
-    20, 21, 22, 22, 23, 20  // Left
+// Outward normal and value of each face, in the same order as d6vertices (opposite faces add up to 7)
+const glm::vec3 d6FaceNormals[] = {
+    glm::vec3(-1.0f,  0.0f,  0.0f), // Left
+    glm::vec3( 0.0f,  1.0f,  0.0f), // Top
+    glm::vec3( 0.0f, -1.0f,  0.0f), // Bottom
+    glm::vec3( 0.0f,  0.0f, -1.0f), // Front
+    glm::vec3( 1.0f,  0.0f,  0.0f), // Right
+    glm::vec3( 0.0f,  0.0f,  1.0f), // Back
 };
+const int d6FaceValues[] = { 1, 2, 5, 3, 6, 4 };
+
+int d6FaceTowards(const glm::quat& rotation, const glm::vec3& direction) {
+    int bestFace = 0;
+    float bestDot = -2.0f;
+    for (int i = 0; i < 6; ++i) {
+        float facing = glm::dot(rotation * d6FaceNormals[i], direction);
+        if (facing > bestDot) {
+            bestDot = facing;
+            bestFace = i;
+        }
+    }
+    return d6FaceValues[bestFace];
+}
 
 
 void createCubeGeometry(GLuint& VAO, GLuint& VBO, GLuint& EBO, int dice, unsigned int& indexCount) {
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
-
-    for (float val : d6vertices) {
-        vertices.push_back(val);
-    }
-    for (unsigned int index : d6indices) {
-        indices.push_back(index);
-    }
+    getCubeGeometry(vertices, indices);
 
 
     // After creating vertices and indices, add logging:
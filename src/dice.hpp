@@ -5,9 +5,14 @@
 #include <vector>
 #include <utility> // For std::pair
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 // std::pair<std::vector<float>, std::vector<unsigned int>> createCubeGeometry();
 
 void createCubeGeometry(GLuint& VAO, GLuint& VBO, GLuint& EBO, int dice, unsigned int& indexCount);
 
+// Value (1-6) of the d6 face pointing most towards direction once the cube is rotated by rotation
+int d6FaceTowards(const glm::quat& rotation, const glm::vec3& direction);
+
 #endif // DICE_HPP
\ No newline at end of file
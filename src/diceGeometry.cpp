@@ -0,0 +1,57 @@
+//diceGeometry.cpp
+#include "diceGeometry.hpp"
+#include <iterator>
+
+
+float d6vertices[] = {
+    // positions          // colors             // Face: Left (Yellow)
+    -0.5f, -0.5f,  0.5f,  1.0f, 1.0f, 0.0f, // 12 (was 4)
+    -0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 0.0f, // 13 (was 0)
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 0.0f, // 14 (was 3)
+    -0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.0f, // 15 (was 7)
+
+    // positions          // colors             // Face: Top (Magenta)
+    -0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 1.0f, // 16 (was 3)
+    0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 1.0f, // 17 (was 2)
+    0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 1.0f, // 18 (was 6)
+    -0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 1.0f, // 19 (was 7)
+
+    // positions          // colors             // Face: Bottom (Cyan)
+    -0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 1.0f, // 20 (was 4)
+    0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 1.0f, // 21 (was 5)
+    0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f, // 22 (was 1)
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 1.0f,  // 23 (was 0)
+
+    // positions          // colors             // Face: Front (Red)
+    -0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 0
+    0.5f, -0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 1
+    0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 2
+    -0.5f,  0.5f, -0.5f,  1.0f, 0.0f, 0.0f, // 3
+
+    // positions          // colors             // Face: Right (Green)
+    0.5f, -0.5f, -0.5f,  0.0f, 1.0f, 0.0f, // 4 (was 1)
+    0.5f, -0.5f,  0.5f,  0.0f, 1.0f, 0.0f, // 5
+    0.5f,  0.5f,  0.5f,  0.0f, 1.0f, 0.0f, // 6
+    0.5f,  0.5f, -0.5f,  0.0f, 1.0f, 0.0f, // 7 (was 2)
+
+    // positions          // colors             // Face: Back (Blue)
+    0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 8 (was 5)
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 9 (was 4)
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 10 (was 7)
+    0.5f,  0.5f,  0.5f,  0.0f, 0.0f, 1.0f, // 11 (was 6)
+};
+
+unsigned int d6indices[] = {
+    0,  1,  2,  2,  3,  0,   // Front
+    4,  5,  6,  6,  7,  4,   // Back
+    8,  9,  10, 10, 11, 8,   // Top
+    12, 13, 14, 14, 15, 12,  // Bottom
+    16, 17, 18, 18, 19, 16,  // Right
+    20, 21, 22, 22, 23, 20  // Left
+};
+
+
+void getCubeGeometry(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    vertices.assign(std::begin(d6vertices), std::end(d6vertices));
+    indices.assign(std::begin(d6indices), std::end(d6indices));
+}
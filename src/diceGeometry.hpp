@@ -0,0 +1,10 @@
+// diceGeometry.hpp
+#ifndef DICE_GEOMETRY_HPP
+#define DICE_GEOMETRY_HPP
+
+#include <vector>
+
+// Interleaved d6 vertices (position xyz, colour rgb) and triangle indices, no OpenGL needed
+void getCubeGeometry(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+#endif // DICE_GEOMETRY_HPP
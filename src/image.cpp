@@ -0,0 +1,122 @@
+// image.cpp
+#include "image.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+double compareImages(const Image& a, const Image& b, int tolerance) {
+    if (a.width != b.width || a.height != b.height || a.pixels.size() != b.pixels.size()) {
+        return 1.0;
+    }
+    size_t pixelCount = a.pixels.size() / 4;
+    if (pixelCount == 0) {
+        return 0.0;
+    }
+
+    size_t different = 0;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (int channel = 0; channel < 4; ++channel) {
+            if (std::abs(a.pixels[i * 4 + channel] - b.pixels[i * 4 + channel]) > tolerance) {
+                ++different;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / pixelCount;
+}
+
+bool writePPM(const Image& image, const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open image file: " << path << std::endl;
+        return false;
+    }
+
+    std::fprintf(file, "P6\n%d %d\n255\n", image.width, image.height);
+    std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+    for (int y = image.height - 1; y >= 0; --y) { // PPM is top row first
+        const uint8_t* source = &image.pixels[static_cast<size_t>(y) * image.width * 4];
+        for (int x = 0; x < image.width; ++x) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+
+    bool ok = std::fclose(file) == 0;
+    if (!ok) {
+        std::cerr << "Failed to write image file: " << path << std::endl;
+    }
+    return ok;
+}
+
+// Next whitespace separated number of a PPM header, skipping # comments
+// Largest width, height or maximum value the PPM format allows
+static const int maxPPMHeaderValue = 65535;
+
+static bool readPPMHeaderValue(FILE* file, int& value) {
+    int c = std::fgetc(file);
+    while (c != EOF && (std::isspace(c) || c == '#')) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = std::fgetc(file);
+        }
+        c = std::fgetc(file);
+    }
+    if (c == EOF || !std::isdigit(c)) return false;
+
+    value = 0;
+    while (c != EOF && std::isdigit(c)) {
+        value = value * 10 + (c - '0');
+        if (value > maxPPMHeaderValue) return false; // Checked every digit so the next multiply cannot overflow
+        c = std::fgetc(file);
+    }
+    return c != EOF && std::isspace(c); // Exactly one whitespace ends the header value
+}
+
+bool readPPM(const std::string& path, Image& image) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open image file: " << path << std::endl;
+        return false;
+    }
+
+    char magic[2] = {};
+    int width = 0, height = 0, maxValue = 0;
+    bool ok = std::fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && magic[1] == '6'
+        && readPPMHeaderValue(file, width) && readPPMHeaderValue(file, height) && readPPMHeaderValue(file, maxValue)
+        && width > 0 && height > 0 && maxValue == 255;
+
+    // Make sure the file really holds that many pixels before allocating for them
+    if (ok) {
+        long dataStart = std::ftell(file);
+        ok = dataStart >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+        long dataEnd = ok ? std::ftell(file) : -1;
+        ok = ok && dataEnd - dataStart >= static_cast<long long>(width) * height * 3
+            && std::fseek(file, dataStart, SEEK_SET) == 0;
+    }
+
+    if (ok) {
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+        for (int y = height - 1; ok && y >= 0; --y) { // Stored bottom row first like glReadPixels
+            ok = std::fread(row.data(), 1, row.size(), file) == row.size();
+            uint8_t* target = &image.pixels[static_cast<size_t>(y) * width * 4];
+            for (int x = 0; ok && x < width; ++x) {
+                target[x * 4 + 0] = row[x * 3 + 0];
+                target[x * 4 + 1] = row[x * 3 + 1];
+                target[x * 4 + 2] = row[x * 3 + 2];
+                target[x * 4 + 3] = 255;
+            }
+        }
+    }
+    std::fclose(file);
+
+    if (!ok) {
+        std::cerr << "Not a readable 8 bit binary PPM: " << path << std::endl;
+    }
+    return ok;
+}
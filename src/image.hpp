@@ -0,0 +1,25 @@
+// image.hpp
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RGBA8 image, rows stored bottom first like glReadPixels so it can be compared with GL output directly
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Fraction of pixels where any channel differs by more than tolerance (1.0 if the sizes differ)
+double compareImages(const Image& a, const Image& b, int tolerance);
+
+// Write a binary PPM (top row first)
+bool writePPM(const Image& image, const std::string& path);
+
+// Read a binary PPM (8 bits per channel) written by writePPM or any other tool, e.g. a GL golden image
+bool readPPM(const std::string& path, Image& image);
+
+#endif // IMAGE_HPP
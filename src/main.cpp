@@ -2,8 +2,14 @@
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <cmath>
+#include <cstdio>
 #include <vector>
+#include <string>
 #include "dice.hpp"
+#include "damage.hpp"
+#include "culling.hpp"
+#include "analytics.hpp"
+#include "image.hpp"
 //#include "slider.hpp" // Removed slider header include
 #include <GL/glew.h>
 #include <glm/glm.hpp>
@@ -23,6 +29,7 @@ void MakeWindowTransparent(sf::Window& window) {
 #endif
 
 sf::Window* InitialiseWindow() {
+#ifdef _WIN32
     int screenWidth = GetSystemMetrics(SM_CXSCREEN); // Get screen width
     int screenHeight = GetSystemMetrics(SM_CYSCREEN); // Get full screen height
     int taskbarHeight = 0;
@@ -39,6 +46,12 @@ sf::Window* InitialiseWindow() {
 
 
     int windowHeight = screenHeight - taskbarHeight; // Calculate window height excluding taskbar
+#else
+    // No taskbar query outside Windows, cover the whole desktop
+    sf::VideoMode desktopMode = sf::VideoMode::getDesktopMode();
+    int screenWidth = static_cast<int>(desktopMode.width);
+    int windowHeight = static_cast<int>(desktopMode.height);
+#endif
 
     sf::ContextSettings settings;
     settings.depthBits = 24; // Set depth bits for OpenGL context
@@ -185,6 +198,18 @@ void checkGLError(const char* operation) {
     }
 }
 
+// Read back the frame that was just drawn (before it is presented) and save it as a PPM,
+// e.g. a golden image for thumbnails --compare
+bool captureFrame(int width, int height, const std::string& path) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+    checkGLError("glReadPixels");
+    return writePPM(image, path);
+}
 
 int main() {
     std::cout << "Program starting..." << std::endl;
@@ -220,6 +245,13 @@ int main() {
     glm::vec3 angularVelocity = glm::vec3(0.0f);
     float angularDecayRate = 0.98f;
     float minAngularVelocity = 0.0001f; // Threshold to stop rolling
+    bool isRolling = false; // Set by a flick, cleared when the roll result is recorded
+    RollAnalytics rollAnalytics; // Face histograms and fairness statistics of every roll
+    RollStream rollStream;
+    const std::string rollStatsPath = "roll_stats.bin"; // Statistics of every session, kept across launches
+    if (rollAnalytics.loadSnapshot(rollStatsPath)) {
+        std::cout << "Loaded " << rollAnalytics.report(DieType::D6).rolls << " previous rolls" << std::endl;
+    }
     std::cout << "Variables initilaised" << std::endl;
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
@@ -271,6 +303,14 @@ int main() {
 
 
     bool isWindowClosed = false; // **ADD THIS FLAG**
+    DamageTracker damageTracker; // Tracks which part of the screen the dice cover
+    DiceSpheres diceSpheres; // Bounding spheres used for frustum culling and LOD selection
+    diceSpheres.resize(1);
+    diceSpheres.set(0, glm::vec3(0.0f), glm::length(cubeMax));
+    LodSettings lodSettings;
+    CullResult cullResult;
+    bool captureRequested = false; // F12 saves the next frame
+    int captureCount = 0;
 
     // Main loop
     while (window.isOpen()) {
@@ -330,10 +370,14 @@ int main() {
                         // Convert sf::Vector2i components to float for glm::vec3 construction
                         flickDirection = glm::normalize(glm::vec3(static_cast<float>(flickVector2D.x), -static_cast<float>(flickVector2D.y), 0.5f)); // Explicit conversion to float
                         angularVelocity = glm::cross(glm::vec3(0.0f, 0.0f, 1.0f), flickDirection) * flickForce;
+                        isRolling = glm::length(angularVelocity) > minAngularVelocity; // A tap without a drag is not a roll
                         std::cout << "Flicked! Force: " << flickForce << ", Direction: " << flickDirection.x << ", " << flickDirection.y << ", " << flickDirection.z << std::endl;
                     }
                 }
             }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12) {
+                captureRequested = true;
+            }
             else if (event.type == sf::Event::MouseMoved) {
                     if (isDragging && !isSliderDragging && !isCubeClicked) {
                     sf::Vector2i currentMousePos = sf::Mouse::getPosition(window);
@@ -359,8 +403,33 @@ int main() {
         }
         else {
             angularVelocity = glm::vec3(0.0f); // Stop rolling if velocity is very small
+            if (isRolling) { // The die just came to rest, record the face looking at the camera
+                isRolling = false;
+                int face = d6FaceTowards(rotationQuat, glm::normalize(cameraPos - cameraTarget));
+                rollAnalytics.recordRoll(rollStream, DieType::D6, face);
+                rollAnalytics.saveSnapshot(rollStatsPath); // Saved after every roll so a crash loses nothing
+                FairnessReport fairness = rollAnalytics.report(DieType::D6);
+                std::cout << "Rolled " << face << " (rolls: " << fairness.rolls << ", chi-square: " << fairness.chiSquare
+                          << ", entropy: " << fairness.entropy << "/" << fairness.maxEntropy
+                          << ", serial correlation: " << fairness.serialCorrelation << ")" << std::endl;
+            }
         }
         // --- End Apply Rolling Motion ---
+
+        // --- Work out which part of the screen changed ---
+        int windowWidth = static_cast<int>(window.getSize().x);
+        int windowHeight = static_cast<int>(window.getSize().y);
+        glm::mat4 damageMVP = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f)
+            * glm::lookAt(cameraPos, cameraTarget, cameraUp)
+            * glm::mat4_cast(rotationQuat);
+        damageTracker.beginFrame(windowWidth, windowHeight);
+        damageTracker.addRect(projectBoundsToScreen(cubeMin, cubeMax, damageMVP, windowWidth, windowHeight));
+        ScreenRect repaintRegion = damageTracker.repaintRegion(queryBufferAge());
+        // Clear and draw only inside the repaint region, the rest of the back buffer is still valid
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(repaintRegion.x, repaintRegion.y, repaintRegion.width, repaintRegion.height);
+        // --- End damage tracking ---
+
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // Dark cyan, fully opaque
         //glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // Transparent background (RGBA: Black, Alpha 0)
         // Clear the screen and depth buffer
@@ -447,15 +516,32 @@ int main() {
 
             // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Enable wireframe mode, needs to be before glDrawlements
 
+            // Only draw the dice that survive frustum culling
+            cullDice(diceSpheres, extractFrustumPlanes(projection * view), cameraPos, projectionPixelScale(projection, windowHeight), lodSettings, cullResult);
             checkGLError("Before glDrawElements");
-            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+            // The scene is one die with one mesh, so the LOD lists only decide whether it is drawn at all
+            if (cullResult.visibleCount() > 0) {
+                glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+            }
             checkGLError("After glDrawElements");
             glBindVertexArray(0); // **Unbind VAO after drawing**
             checkGLError("After Unbind glBindVertexArray"); // Error check
 
+            if (captureRequested) {
+                captureRequested = false;
+                std::string capturePath = "capture_" + std::to_string(captureCount++) + ".ppm";
+                if (captureFrame(windowWidth, windowHeight, capturePath)) {
+                    // Full precision so the software rasterizer can render exactly the same pose
+                    char rotation[96];
+                    std::snprintf(rotation, sizeof(rotation), "%.9g %.9g %.9g %.9g", rotationQuat.w, rotationQuat.x, rotationQuat.y, rotationQuat.z);
+                    std::cout << "Saved " << capturePath << ", compare with: thumbnails --compare " << capturePath << " --rotation " << rotation << std::endl;
+                }
+            }
+
 
-            // Update the window
-            window.display();
+            // Update the window, only the damaged part has to reach the screen
+            presentWithDamage(window, damageTracker.swapDamage());
+            damageTracker.endFrame();
         } else {
             std::cout << "Window rendering skipped because isWindowClosed is true" << std::endl; // Debug output
         }
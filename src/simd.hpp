@@ -0,0 +1,17 @@
+// simd.hpp
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// Instruction set for the culling and rasterizer inner loops: AVX when the compiler targets it
+// (-mavx, /arch:AVX), otherwise SSE which every x86-64 CPU has. Defining DICE_NO_SIMD forces the
+// portable scalar code, which is what other architectures get.
+#if defined(DICE_NO_SIMD)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define DICE_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DICE_SIMD_SSE
+#endif
+
+#endif // SIMD_HPP
@@ -0,0 +1,406 @@
+// softwareRasterizer.cpp
+#include "softwareRasterizer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "simd.hpp"
+
+static const int tileSize = 32;
+// Pixels are tested this many at a time: one AVX register, two SSE registers, or eight lanes of branch free scalar code
+static const int rasterLanes = 8;
+static const int vertexStride = 6; // position xyz, colour rgb
+#if !defined(DICE_SIMD_AVX) && !defined(DICE_SIMD_SSE)
+static const int laneBit[rasterLanes] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+#endif
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, unsigned int threadCount)
+    : width(width), height(height), threadCount(threadCount) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+    colour.width = width;
+    colour.height = height;
+    colour.pixels.resize(static_cast<size_t>(width) * height * 4);
+    // Depth rows are padded to whole tiles so a group of lanes never reads or writes past its own tile
+    depthStride = tilesX * tileSize;
+    depthBuffer.resize(static_cast<size_t>(depthStride) * height);
+    tileBins.resize(static_cast<size_t>(tilesX) * tilesY);
+    unsigned int usefulThreads = std::min<unsigned int>(this->threadCount, static_cast<unsigned int>(tilesX * tilesY));
+    if (usefulThreads > 1) {
+        workers.reset(new WorkerPool(usefulThreads - 1));
+    }
+    clear(glm::vec3(0.0f));
+}
+
+// Round to nearest even like the GPU's float to UNORM8 conversion (0.3 * 255 = 76.5 becomes 76, not 77)
+static uint8_t toByte(float value) {
+    return static_cast<uint8_t>(std::nearbyint(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+}
+
+void SoftwareRasterizer::clear(const glm::vec3& clearColour) {
+    uint8_t r = toByte(clearColour.x), g = toByte(clearColour.y), b = toByte(clearColour.z);
+    size_t pixelCount = colour.pixels.size() / 4;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        colour.pixels[i * 4 + 0] = r;
+        colour.pixels[i * 4 + 1] = g;
+        colour.pixels[i * 4 + 2] = b;
+        colour.pixels[i * 4 + 3] = 255;
+    }
+    std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+}
+
+struct ClipVertex {
+    glm::vec4 position;
+    glm::vec3 colour;
+};
+
+// Clip a triangle against the near plane (z >= -w), the other planes are handled by the
+// bounding box and the depth range test. Returns the number of vertices written to out (0, 3 or 4).
+static int clipNear(const ClipVertex in[3], ClipVertex out[4]) {
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        const ClipVertex& a = in[i];
+        const ClipVertex& b = in[(i + 1) % 3];
+        float distanceA = a.position.z + a.position.w;
+        float distanceB = b.position.z + b.position.w;
+        if (distanceA >= 0.0f) {
+            out[count++] = a;
+        }
+        if ((distanceA >= 0.0f) != (distanceB >= 0.0f)) {
+            float t = distanceA / (distanceA - distanceB);
+            out[count].position = a.position + (b.position - a.position) * t;
+            out[count].colour = a.colour + (b.colour - a.colour) * t;
+            ++count;
+        }
+    }
+    return count;
+}
+
+void SoftwareRasterizer::drawMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::vector<glm::mat4>& models,
+                                  const glm::mat4& projection, const glm::mat4& view, ShadeMode mode) {
+    triangles.clear();
+    for (std::vector<unsigned int>& bin : tileBins) {
+        bin.clear();
+    }
+
+    // Vertex stage, same as vertexShaderSource
+    size_t vertexCount = vertices.size() / vertexStride;
+    clipPositions.resize(vertexCount);
+    for (const glm::mat4& model : models) {
+        glm::mat4 mvp = projection * view * model;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const float* v = &vertices[i * vertexStride];
+            clipPositions[i] = mvp * glm::vec4(v[0], v[1], v[2], 1.0f);
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            ClipVertex corners[3];
+            for (int k = 0; k < 3; ++k) {
+                unsigned int index = indices[i + k];
+                const float* v = &vertices[index * vertexStride];
+                corners[k].position = clipPositions[index];
+                corners[k].colour = glm::vec3(v[3], v[4], v[5]);
+            }
+
+            ClipVertex clipped[4];
+            int clippedCount = clipNear(corners, clipped);
+            for (int k = 1; k + 1 < clippedCount; ++k) {
+                glm::vec4 positions[3] = { clipped[0].position, clipped[k].position, clipped[k + 1].position };
+                glm::vec3 colours[3] = { clipped[0].colour, clipped[k].colour, clipped[k + 1].colour };
+                if (mode == ShadeMode::Flat) {
+                    colours[0] = colours[1] = colours[2] = corners[2].colour;
+                }
+                setupTriangle(positions, colours, mode == ShadeMode::Flat);
+            }
+        }
+    }
+
+    // Binning stays in draw order so equal depths resolve the same way as GL_LESS on the GPU
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        const Triangle& triangle = triangles[t];
+        for (int ty = triangle.minY / tileSize; ty <= triangle.maxY / tileSize; ++ty) {
+            for (int tx = triangle.minX / tileSize; tx <= triangle.maxX / tileSize; ++tx) {
+                tileBins[ty * tilesX + tx].push_back(static_cast<unsigned int>(t));
+            }
+        }
+    }
+
+    // Tiles never share pixels so workers only need a shared counter to split the work
+    std::atomic<int> nextTile(0);
+    auto worker = [this, &nextTile](size_t) {
+        int tileCount = tilesX * tilesY;
+        for (int tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1)) {
+            if (!tileBins[tile].empty()) {
+                rasterizeTile(tile % tilesX, tile / tilesX);
+            }
+        }
+    };
+
+    if (workers) {
+        workers->run(workers->size(), worker);
+    } else {
+        worker(0);
+    }
+}
+
+void SoftwareRasterizer::setupTriangle(const glm::vec4 clip[3], const glm::vec3 colours[3], bool flat) {
+    // Perspective divide and viewport transform (window coordinates, y up, pixel centres at +0.5)
+    float x[3], y[3], z[3], invW[3];
+    for (int i = 0; i < 3; ++i) {
+        invW[i] = 1.0f / clip[i].w;
+        x[i] = (clip[i].x * invW[i] * 0.5f + 0.5f) * width;
+        y[i] = (clip[i].y * invW[i] * 0.5f + 0.5f) * height;
+        z[i] = clip[i].z * invW[i] * 0.5f + 0.5f;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0f || !std::isfinite(area)) {
+        return;
+    }
+
+    // Back faces are drawn too (GL_CULL_FACE is disabled), flip them to counter clockwise
+    int order[3] = { 0, 1, 2 };
+    if (area < 0.0f) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (int e = 0; e < 3; ++e) {
+        // Edge e is opposite vertex e
+        int a = order[(e + 1) % 3];
+        int b = order[(e + 2) % 3];
+        triangle.edgeA[e] = y[a] - y[b];
+        triangle.edgeB[e] = x[b] - x[a];
+        triangle.edgeC[e] = -(triangle.edgeA[e] * x[a] + triangle.edgeB[e] * y[a]);
+
+        minX = std::min(minX, x[e]);
+        minY = std::min(minY, y[e]);
+        maxX = std::max(maxX, x[e]);
+        maxY = std::max(maxY, y[e]);
+    }
+
+    triangle.minX = std::max(0, static_cast<int>(std::floor(minX)));
+    triangle.minY = std::max(0, static_cast<int>(std::floor(minY)));
+    triangle.maxX = std::min(width - 1, static_cast<int>(std::ceil(maxX)));
+    triangle.maxY = std::min(height - 1, static_cast<int>(std::ceil(maxY)));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    // Any value given per vertex becomes a plane over the screen: sum(edge_e * value_e) / area
+    auto plane = [&](const float values[3], float out[3]) {
+        float invArea = 1.0f / area;
+        out[0] = out[1] = out[2] = 0.0f;
+        for (int e = 0; e < 3; ++e) {
+            float value = values[order[e]] * invArea;
+            out[0] += triangle.edgeA[e] * value;
+            out[1] += triangle.edgeB[e] * value;
+            out[2] += triangle.edgeC[e] * value;
+        }
+    };
+
+    plane(z, triangle.depth);
+    plane(invW, triangle.invW);
+    for (int channel = 0; channel < 3; ++channel) {
+        float values[3];
+        for (int i = 0; i < 3; ++i) {
+            values[i] = colours[i][channel] * invW[i];
+        }
+        plane(values, triangle.colourOverW[channel]);
+        triangle.flatColour[channel] = colours[2][channel];
+    }
+    triangle.flat = flat;
+
+    triangles.push_back(triangle);
+}
+
+void SoftwareRasterizer::rasterizeTile(int tileX, int tileY) {
+    int tileMinX = tileX * tileSize;
+    int tileMinY = tileY * tileSize;
+    int tileMaxX = std::min(tileMinX + tileSize, width) - 1;
+    int tileMaxY = std::min(tileMinY + tileSize, height) - 1;
+
+    for (unsigned int t : tileBins[tileY * tilesX + tileX]) {
+        const Triangle& triangle = triangles[t];
+        int x0 = std::max(triangle.minX, tileMinX);
+        int x1 = std::min(triangle.maxX, tileMaxX);
+        int y0 = std::max(triangle.minY, tileMinY);
+        int y1 = std::min(triangle.maxY, tileMaxY);
+        // Lane groups start on a multiple of rasterLanes inside the tile, lanes outside [x0, x1] are masked off
+        int groupStart = tileMinX + (x0 - tileMinX) / rasterLanes * rasterLanes;
+
+#if !defined(DICE_SIMD_AVX) && !defined(DICE_SIMD_SSE)
+        // Copies of the plane coefficients, the compiler cannot keep them in registers across the depth buffer stores
+        float depthX = triangle.depth[0], depthC = triangle.depth[2];
+        float invWX = triangle.invW[0], invWC = triangle.invW[2];
+#endif
+
+        // Top-left fill rule so pixels on shared edges are drawn exactly once
+        int topLeft[3];
+        for (int e = 0; e < 3; ++e) {
+            topLeft[e] = triangle.edgeA[e] > 0.0f || (triangle.edgeA[e] == 0.0f && triangle.edgeB[e] < 0.0f);
+        }
+
+        for (int py = y0; py <= y1; ++py) {
+            float sampleY = py + 0.5f;
+            size_t row = static_cast<size_t>(py) * width;
+            float* depthRow = &depthBuffer[static_cast<size_t>(py) * depthStride];
+
+            float rowEdge[3];
+            for (int e = 0; e < 3; ++e) {
+                rowEdge[e] = triangle.edgeB[e] * sampleY + triangle.edgeC[e];
+            }
+            float rowDepth = triangle.depth[1] * sampleY;
+            float rowInvW = triangle.invW[1] * sampleY;
+            float rowColour[3];
+            for (int channel = 0; channel < 3; ++channel) {
+                rowColour[channel] = triangle.colourOverW[channel][1] * sampleY;
+            }
+
+            for (int px = groupStart; px <= x1; px += rasterLanes) {
+                // Bit per lane that passes coverage and the depth test, the colours of those lanes
+                int mask = 0;
+                alignas(32) float shade[3][rasterLanes];
+#if defined(DICE_SIMD_AVX)
+                __m256 sampleX = _mm256_add_ps(_mm256_set1_ps(px + 0.5f), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+                __m256 zero = _mm256_setzero_ps();
+                __m256 pass = _mm256_and_ps(_mm256_cmp_ps(sampleX, _mm256_set1_ps(x0 + 0.5f), _CMP_GE_OQ),
+                                            _mm256_cmp_ps(sampleX, _mm256_set1_ps(x1 + 0.5f), _CMP_LE_OQ));
+                for (int e = 0; e < 3; ++e) {
+                    __m256 edge = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.edgeA[e]), sampleX), _mm256_set1_ps(rowEdge[e]));
+                    __m256 onEdge = _mm256_and_ps(_mm256_cmp_ps(edge, zero, _CMP_EQ_OQ), _mm256_castsi256_ps(_mm256_set1_epi32(-topLeft[e])));
+                    pass = _mm256_and_ps(pass, _mm256_or_ps(_mm256_cmp_ps(edge, zero, _CMP_GT_OQ), onEdge));
+                }
+                if (_mm256_movemask_ps(pass) == 0) continue;
+
+                // Depth outside [0, 1] would have been clipped by the near/far planes on the GPU
+                __m256 depth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.depth[0]), sampleX), _mm256_set1_ps(rowDepth)),
+                                             _mm256_set1_ps(triangle.depth[2]));
+                __m256 stored = _mm256_loadu_ps(depthRow + px);
+                pass = _mm256_and_ps(pass, _mm256_and_ps(_mm256_cmp_ps(depth, zero, _CMP_GE_OQ), _mm256_cmp_ps(depth, _mm256_set1_ps(1.0f), _CMP_LE_OQ)));
+                pass = _mm256_and_ps(pass, _mm256_cmp_ps(depth, stored, _CMP_LT_OQ));
+                mask = _mm256_movemask_ps(pass);
+                if (mask == 0) continue;
+                _mm256_storeu_ps(depthRow + px, _mm256_blendv_ps(stored, depth, pass));
+
+                if (triangle.flat) {
+                    for (int channel = 0; channel < 3; ++channel) {
+                        _mm256_store_ps(shade[channel], _mm256_set1_ps(triangle.flatColour[channel]));
+                    }
+                } else {
+                    __m256 invW = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.invW[0]), sampleX), _mm256_set1_ps(rowInvW)),
+                                                _mm256_set1_ps(triangle.invW[2]));
+                    __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), invW);
+                    for (int channel = 0; channel < 3; ++channel) {
+                        const float* plane = triangle.colourOverW[channel];
+                        __m256 value = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[0]), sampleX), _mm256_set1_ps(rowColour[channel])),
+                                                     _mm256_set1_ps(plane[2]));
+                        _mm256_store_ps(shade[channel], _mm256_mul_ps(value, w));
+                    }
+                }
+#elif defined(DICE_SIMD_SSE)
+                // Two 4 wide halves of the group
+                for (int half = 0; half < rasterLanes; half += 4) {
+                    __m128 sampleX = _mm_add_ps(_mm_set1_ps(px + half + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                    __m128 zero = _mm_setzero_ps();
+                    __m128 pass = _mm_and_ps(_mm_cmpge_ps(sampleX, _mm_set1_ps(x0 + 0.5f)), _mm_cmple_ps(sampleX, _mm_set1_ps(x1 + 0.5f)));
+                    for (int e = 0; e < 3; ++e) {
+                        __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edgeA[e]), sampleX), _mm_set1_ps(rowEdge[e]));
+                        __m128 onEdge = _mm_and_ps(_mm_cmpeq_ps(edge, zero), _mm_castsi128_ps(_mm_set1_epi32(-topLeft[e])));
+                        pass = _mm_and_ps(pass, _mm_or_ps(_mm_cmpgt_ps(edge, zero), onEdge));
+                    }
+                    if (_mm_movemask_ps(pass) == 0) continue;
+
+                    __m128 depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.depth[0]), sampleX), _mm_set1_ps(rowDepth)),
+                                              _mm_set1_ps(triangle.depth[2]));
+                    __m128 stored = _mm_loadu_ps(depthRow + px + half);
+                    pass = _mm_and_ps(pass, _mm_and_ps(_mm_cmpge_ps(depth, zero), _mm_cmple_ps(depth, _mm_set1_ps(1.0f))));
+                    pass = _mm_and_ps(pass, _mm_cmplt_ps(depth, stored));
+                    int halfMask = _mm_movemask_ps(pass);
+                    if (halfMask == 0) continue;
+                    mask |= halfMask << half;
+                    _mm_storeu_ps(depthRow + px + half, _mm_or_ps(_mm_and_ps(pass, depth), _mm_andnot_ps(pass, stored)));
+
+                    if (triangle.flat) {
+                        for (int channel = 0; channel < 3; ++channel) {
+                            _mm_store_ps(shade[channel] + half, _mm_set1_ps(triangle.flatColour[channel]));
+                        }
+                    } else {
+                        __m128 invW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.invW[0]), sampleX), _mm_set1_ps(rowInvW)),
+                                                 _mm_set1_ps(triangle.invW[2]));
+                        __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), invW);
+                        for (int channel = 0; channel < 3; ++channel) {
+                            const float* plane = triangle.colourOverW[channel];
+                            __m128 value = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), sampleX), _mm_set1_ps(rowColour[channel])),
+                                                      _mm_set1_ps(plane[2]));
+                            _mm_store_ps(shade[channel] + half, _mm_mul_ps(value, w));
+                        }
+                    }
+                }
+                if (mask == 0) continue;
+#else
+                // Same maths one lane at a time, branch free so the compiler can vectorise the lane loops
+                float sampleX[rasterLanes];
+                int pass[rasterLanes];
+                for (int lane = 0; lane < rasterLanes; ++lane) {
+                    sampleX[lane] = px + lane + 0.5f;
+                    pass[lane] = (px + lane >= x0) & (px + lane <= x1);
+                }
+                for (int e = 0; e < 3; ++e) {
+                    float edgeA = triangle.edgeA[e];
+                    for (int lane = 0; lane < rasterLanes; ++lane) {
+                        float edge = edgeA * sampleX[lane] + rowEdge[e];
+                        pass[lane] &= (edge > 0.0f) | ((edge == 0.0f) & topLeft[e]);
+                    }
+                }
+
+                float* stored = depthRow + px;
+                for (int lane = 0; lane < rasterLanes; ++lane) {
+                    float depth = depthX * sampleX[lane] + rowDepth + depthC;
+                    pass[lane] &= (depth >= 0.0f) & (depth <= 1.0f) & (depth < stored[lane]);
+                    stored[lane] = pass[lane] ? depth : stored[lane];
+                }
+                for (int lane = 0; lane < rasterLanes; ++lane) {
+                    mask |= laneBit[lane] & -pass[lane];
+                }
+                if (mask == 0) continue;
+
+                if (triangle.flat) {
+                    for (int channel = 0; channel < 3; ++channel) {
+                        for (int lane = 0; lane < rasterLanes; ++lane) {
+                            shade[channel][lane] = triangle.flatColour[channel];
+                        }
+                    }
+                } else {
+                    float w[rasterLanes];
+                    for (int lane = 0; lane < rasterLanes; ++lane) {
+                        w[lane] = 1.0f / (invWX * sampleX[lane] + rowInvW + invWC);
+                    }
+                    for (int channel = 0; channel < 3; ++channel) {
+                        float colourX = triangle.colourOverW[channel][0];
+                        float colourC = triangle.colourOverW[channel][2];
+                        for (int lane = 0; lane < rasterLanes; ++lane) {
+                            shade[channel][lane] = (colourX * sampleX[lane] + rowColour[channel] + colourC) * w[lane];
+                        }
+                    }
+                }
+#endif
+
+                // Only the lanes that passed are written
+                for (int lane = 0; lane < rasterLanes; ++lane) {
+                    if (!(mask & (1 << lane))) continue;
+                    size_t pixel = row + px + lane;
+                    colour.pixels[pixel * 4 + 0] = toByte(shade[0][lane]);
+                    colour.pixels[pixel * 4 + 1] = toByte(shade[1][lane]);
+                    colour.pixels[pixel * 4 + 2] = toByte(shade[2][lane]);
+                    colour.pixels[pixel * 4 + 3] = 255;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+// softwareRasterizer.hpp
+#ifndef SOFTWARE_RASTERIZER_HPP
+#define SOFTWARE_RASTERIZER_HPP
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "image.hpp"
+#include "workerPool.hpp"
+
+enum class ShadeMode {
+    Smooth, // Per vertex colour, perspective correct like the GL shader pair
+    Flat    // Colour of the last vertex of each triangle (GL's provoking vertex)
+};
+
+// CPU replacement for the GL draw path: same interleaved vertex layout as createCubeGeometry
+// (position xyz, colour rgb), same projection * view * model transform, depth test with GL_LESS.
+// The screen is split into tiles that are rasterised in parallel.
+class SoftwareRasterizer {
+public:
+    // threadCount 0 = one thread per core, 1 = render on the calling thread
+    SoftwareRasterizer(int width, int height, unsigned int threadCount = 0);
+
+    // Same as glClearColor + glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)
+    void clear(const glm::vec3& colour);
+
+    // Draw one copy of the mesh per model matrix
+    void drawMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::vector<glm::mat4>& models,
+                  const glm::mat4& projection, const glm::mat4& view, ShadeMode mode = ShadeMode::Smooth);
+
+    const Image& image() const { return colour; }
+
+private:
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3]; // Edge functions A*x + B*y + C, positive inside
+        float depth[3];                     // Plane coefficients for depth: depth[0]*x + depth[1]*y + depth[2]
+        float invW[3];                      // Same for 1/w
+        float colourOverW[3][3];            // Same for colour/w, one plane per channel
+        int minX, minY, maxX, maxY;         // Pixel bounding box, inclusive
+        bool flat;
+        float flatColour[3];
+    };
+
+    void setupTriangle(const glm::vec4 clip[3], const glm::vec3 colours[3], bool flat);
+    void rasterizeTile(int tileX, int tileY);
+
+    int width;
+    int height;
+    unsigned int threadCount;
+    int tilesX;
+    int tilesY;
+    Image colour;
+    int depthStride;
+    std::vector<float> depthBuffer;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<unsigned int>> tileBins; // Triangles touching each tile, in draw order
+    std::vector<glm::vec4> clipPositions;            // Scratch space for the vertex stage, reused between draws
+    std::unique_ptr<WorkerPool> workers;             // Started once when more than one thread is used
+};
+
+#endif // SOFTWARE_RASTERIZER_HPP
@@ -0,0 +1,141 @@
+// thumbnails.cpp
+// Renders random d6 roll snapshots with the software rasterizer, no GPU or window needed.
+// Usage: thumbnails [count] [size] [output directory]
+//        thumbnails --compare <reference.ppm> [--tolerance N] [--max-diff F] [--rotation w x y z] [--output image.ppm]
+// Compare mode renders one frame with the interactive app's camera and projection at the size of the
+// reference (a GL frame saved with F12 in the app, or tests/golden) and fails if too many pixels differ.
+#include "diceGeometry.hpp"
+#include "image.hpp"
+#include "softwareRasterizer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Same camera as main.cpp
+const glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 5.0f);
+const glm::vec3 cameraTarget = glm::vec3(0.0f);
+const glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+const glm::vec3 clearColour = glm::vec3(0.2f, 0.3f, 0.3f);
+
+// Golden image check against a GL reference, returns the process exit code
+int compareWithReference(int argc, char* argv[], const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+    std::string referencePath = argv[2];
+    std::string outputPath;
+    // Defaults leave room for the 4x MSAA edges of the GL window, the rasterizer has no multisampling
+    int tolerance = 8;
+    double maxDifference = 0.02;
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f); // The app starts with the identity rotation
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atoi(argv[++i]);
+        } else if (arg == "--max-diff" && i + 1 < argc) {
+            maxDifference = std::atof(argv[++i]);
+        } else if (arg == "--rotation" && i + 4 < argc) {
+            float w = static_cast<float>(std::atof(argv[i + 1]));
+            float x = static_cast<float>(std::atof(argv[i + 2]));
+            float y = static_cast<float>(std::atof(argv[i + 3]));
+            float z = static_cast<float>(std::atof(argv[i + 4]));
+            rotation = glm::normalize(glm::quat(w, x, y, z));
+            i += 4;
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            std::cerr << "Unknown compare option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    Image reference;
+    if (!readPPM(referencePath, reference)) {
+        return -1;
+    }
+
+    // main.cpp uses a fixed 800x600 aspect whatever the window size, the viewport stretches it
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, cameraUp);
+    std::vector<glm::mat4> models = { glm::mat4_cast(rotation) };
+
+    SoftwareRasterizer rasterizer(reference.width, reference.height);
+    rasterizer.clear(clearColour);
+    rasterizer.drawMesh(vertices, indices, models, projection, view);
+    if (!outputPath.empty()) {
+        writePPM(rasterizer.image(), outputPath);
+    }
+
+    double difference = compareImages(rasterizer.image(), reference, tolerance);
+    bool matches = difference <= maxDifference;
+    std::cout << (matches ? "Match: " : "MISMATCH: ") << difference * 100.0 << "% of pixels differ by more than "
+              << tolerance << " (limit " << maxDifference * 100.0 << "%)" << std::endl;
+    return matches ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    getCubeGeometry(vertices, indices);
+
+    if (argc > 1 && std::string(argv[1]) == "--compare") {
+        if (argc < 3) {
+            std::cerr << "Usage: thumbnails --compare <reference.ppm> [--tolerance N] [--max-diff F] [--rotation w x y z] [--output image.ppm]" << std::endl;
+            return -1;
+        }
+        return compareWithReference(argc, argv, vertices, indices);
+    }
+
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int size = argc > 2 ? std::atoi(argv[2]) : 128;
+    std::string outputDir = argc > 3 ? argv[3] : "";
+    if (count <= 0 || size <= 0) {
+        std::cerr << "Usage: thumbnails [count] [size] [output directory]" << std::endl;
+        return -1;
+    }
+
+    // Camera position as in the app, but square thumbnails use aspect 1 and there is no MSAA,
+    // so the framing is not the app's (compare mode uses the app's projection)
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, cameraUp);
+
+    // Small images do not have enough tiles to keep many threads busy, so each thread renders whole images
+    std::atomic<int> nextImage(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&](unsigned int seed) {
+        SoftwareRasterizer rasterizer(size, size, 1);
+        std::mt19937 random(seed);
+        std::normal_distribution<float> gaussian;
+        for (int i = nextImage.fetch_add(1); i < count; i = nextImage.fetch_add(1)) {
+            glm::quat rotation = glm::normalize(glm::quat(gaussian(random), gaussian(random), gaussian(random), gaussian(random)));
+            std::vector<glm::mat4> models = { glm::mat4_cast(rotation) };
+
+            rasterizer.clear(clearColour);
+            rasterizer.drawMesh(vertices, indices, models, projection, view);
+            if (!outputDir.empty() && !writePPM(rasterizer.image(), outputDir + "/roll_" + std::to_string(i) + ".ppm")) {
+                failed = true;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Rendered " << count << " thumbnails (" << size << "x" << size << ") in " << seconds << "s, "
+              << count / seconds << " frames per second" << std::endl;
+    return failed ? -1 : 0;
+}
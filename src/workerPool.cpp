@@ -0,0 +1,57 @@
+// workerPool.cpp
+#include "workerPool.hpp"
+
+WorkerPool::WorkerPool(size_t workerCount) {
+    for (size_t i = 0; i < workerCount; ++i) {
+        threads.emplace_back(&WorkerPool::workerLoop, this, i + 1);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(size_t chunks, const std::function<void(size_t)>& work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &work;
+        chunkCount = chunks;
+        pending = threads.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pending == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::workerLoop(size_t chunk) {
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+        if (stopping) return;
+        seenGeneration = generation;
+
+        const std::function<void(size_t)>* work = job;
+        bool hasChunk = chunk < chunkCount;
+        lock.unlock();
+        if (hasChunk) {
+            (*work)(chunk);
+        }
+        lock.lock();
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,37 @@
+// workerPool.hpp
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads kept alive between calls so per frame work only has to wake them. run() hands chunk 0
+// to the calling thread and chunk i to worker i, then waits until all of them are done.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t workerCount);
+    ~WorkerPool();
+
+    void run(size_t chunks, const std::function<void(size_t)>& work);
+    size_t size() const { return threads.size() + 1; } // Including the calling thread
+
+private:
+    void workerLoop(size_t chunk);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t chunkCount = 0;
+    size_t pending = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+#endif // WORKER_POOL_HPP
@@ -0,0 +1,117 @@
+// cullingTest.cpp
+// Checks cullDice against a double precision reference of the same sphere/plane and projected radius tests.
+// Built once per instruction set (see CMakeLists.txt) so the AVX, SSE and scalar cullBlock paths are all covered.
+#include "culling.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Dice closer than this to a plane or LOD threshold may land on either side in float, they are not checked
+const double boundaryEpsilon = 1e-4;
+
+// Expected LOD of one die (-1 = culled), computed in double
+int referenceLod(const DiceSpheres& spheres, size_t i, const FrustumPlanes& frustum, const glm::vec3& cameraPos, float pixelScale,
+                 const LodSettings& settings, bool& nearBoundary) {
+    double x = spheres.x[i], y = spheres.y[i], z = spheres.z[i], r = spheres.radius[i];
+    bool inside = true;
+    nearBoundary = false;
+    for (int p = 0; p < 6; ++p) {
+        double distance = frustum.a[p] * x + frustum.b[p] * y + frustum.c[p] * z + frustum.d[p];
+        inside = inside && distance >= -r;
+        nearBoundary = nearBoundary || std::fabs(distance + r) < boundaryEpsilon * std::max(1.0, std::fabs(distance));
+    }
+
+    double dx = x - cameraPos.x, dy = y - cameraPos.y, dz = z - cameraPos.z;
+    double screenRadius = r * pixelScale / std::sqrt(std::max(dx * dx + dy * dy + dz * dz, r * r));
+    inside = inside && screenRadius >= settings.minRadius;
+    nearBoundary = nearBoundary || std::fabs(screenRadius - settings.minRadius) < boundaryEpsilon * settings.minRadius;
+
+    int lod = 0;
+    for (int l = 0; l < diceLodCount - 1; ++l) {
+        lod += screenRadius < settings.lodRadius[l];
+        nearBoundary = nearBoundary || std::fabs(screenRadius - settings.lodRadius[l]) < boundaryEpsilon * settings.lodRadius[l];
+    }
+    return inside ? lod : -1;
+}
+
+// Cull one scene and compare every die with the reference, returns the number of errors
+size_t checkScene(const DiceSpheres& spheres, const glm::vec3& cameraPos, const glm::vec3& cameraTarget, CullResult& result) {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+    FrustumPlanes frustum = extractFrustumPlanes(projection * view);
+    float pixelScale = projectionPixelScale(projection, 600);
+    LodSettings settings;
+
+    auto start = std::chrono::steady_clock::now();
+    cullDice(spheres, frustum, cameraPos, pixelScale, settings, result);
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Turn the lists back into one LOD per die, every list has to be in ascending order without duplicates
+    size_t errors = 0;
+    std::vector<int> lodOfDie(spheres.count, -1);
+    for (int lod = 0; lod < diceLodCount; ++lod) {
+        const std::vector<unsigned int>& list = result.visible[lod];
+        for (size_t k = 0; k < list.size(); ++k) {
+            if (list[k] >= spheres.count || lodOfDie[list[k]] != -1 || (k > 0 && list[k] <= list[k - 1])) {
+                ++errors;
+                continue;
+            }
+            lodOfDie[list[k]] = lod;
+        }
+    }
+
+    size_t skipped = 0;
+    for (size_t i = 0; i < spheres.count; ++i) {
+        bool nearBoundary;
+        int expected = referenceLod(spheres, i, frustum, cameraPos, pixelScale, settings, nearBoundary);
+        if (nearBoundary) {
+            ++skipped;
+        } else if (lodOfDie[i] != expected) {
+            ++errors;
+        }
+    }
+
+    std::cout << spheres.count << " dice: " << result.visibleCount() << " visible (LOD " << result.visible[0].size() << "/"
+              << result.visible[1].size() << "/" << result.visible[2].size() << ") in " << milliseconds << "ms, "
+              << skipped << " on a boundary, " << errors << " errors" << std::endl;
+    return errors;
+}
+
+int main() {
+#if defined(DICE_SIMD_AVX)
+    std::cout << "cullBlock path: AVX" << std::endl;
+#elif defined(DICE_SIMD_SSE)
+    std::cout << "cullBlock path: SSE" << std::endl;
+#else
+    std::cout << "cullBlock path: scalar" << std::endl;
+#endif
+
+    size_t errors = 0;
+    CullResult result; // Reused like the app does between frames
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 2.0f);
+
+    // Empty, less than a block, a partial last block, and a scene large enough to be split across threads
+    for (size_t count : { size_t(0), size_t(5), size_t(1001), size_t(2000003) }) {
+        DiceSpheres spheres;
+        spheres.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            spheres.set(i, glm::vec3(position(random), position(random), position(random)), radius(random));
+        }
+        if (count > 0) {
+            spheres.set(0, glm::vec3(0.0f), 0.866f); // The app's die, in view of both cameras
+        }
+        errors += checkScene(spheres, glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), result);
+        errors += checkScene(spheres, glm::vec3(30.0f, -10.0f, 40.0f), glm::vec3(-5.0f, 0.0f, 0.0f), result);
+    }
+
+    std::cout << (errors == 0 ? "PASS" : "FAIL") << std::endl;
+    return errors == 0 ? 0 : 1;
+}